@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <queue>
 #include <climits>
+#include "parallel.h"
 
 using namespace std;
 
@@ -94,7 +95,9 @@ for (vector<int>::iterator it = adj[u].begin(); it != adj[u].end(); ++it) {
 int Graph::edgeConnectivity() {
     int minCut = INT_MAX;
 
-    for (int u = 0; u < V; u++) {
+    // Each removed vertex u is independent of the others, so their BFS runs go in parallel
+    vector<int> cuts(V);
+    parallelFor(0, V, [&](size_t u) {
         vector<bool> visited(V, false);
         visited[u] = true; // Mark vertex u as removed
         int cutSize = 0;
@@ -112,7 +115,11 @@ int Graph::edgeConnectivity() {
                 cutSize = max(cutSize, count);
             }
         }
-        minCut = min(minCut, cutSize);
+        cuts[u] = cutSize;
+    }, 1);
+
+    for (int u = 0; u < V; u++) {
+        minCut = min(minCut, cuts[u]);
     }
     return minCut;
 }
@@ -121,7 +128,9 @@ int Graph::edgeConnectivity() {
 int Graph::vertexConnectivity() {
     int minCut = INT_MAX;
 
-    for (int u = 0; u < V; u++) {
+    // Each removed vertex u is independent of the others, so their BFS runs go in parallel
+    vector<int> counts(V);
+    parallelFor(0, V, [&](size_t u) {
         vector<bool> visited(V, false);
         visited[u] = true; // Mark vertex u as removed
         int count = 0;
@@ -134,7 +143,11 @@ int Graph::vertexConnectivity() {
                 }
             }
         }
-        minCut = min(minCut, count);
+        counts[u] = count;
+    }, 1);
+
+    for (int u = 0; u < V; u++) {
+        minCut = min(minCut, counts[u]);
     }
     return minCut;
 }
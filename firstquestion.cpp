@@ -1,6 +1,12 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <sstream>
+#include "parallel.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -32,7 +38,138 @@ bool havelHakimi(vector<int>& degrees) {
     }
 }
 
-int main() {
+// Scratch buffers reused across the sequences checked by one worker thread
+struct GraphicalScratch {
+    vector<int> count;        // Histogram of degree values for counting sort
+    vector<int> sorted;       // Degrees in non-increasing order
+    vector<long long> prefix; // prefix[k] = sum of the k largest degrees
+};
+
+// Check one degree sequence with the Erdos-Gallai theorem, without modifying it
+bool erdosGallai(const int *degrees, int n, GraphicalScratch &scratch) {
+    if (n == 0) return true;
+
+    // Counting sort: a degree outside [0, n-1] already rules out a simple graph
+    if ((int)scratch.count.size() < n) {
+        scratch.count.resize(n);
+        scratch.sorted.resize(n);
+        scratch.prefix.resize(n + 1);
+    }
+    fill(scratch.count.begin(), scratch.count.begin() + n, 0);
+    for (int i = 0; i < n; i++) {
+        if (degrees[i] < 0 || degrees[i] >= n) return false;
+        scratch.count[degrees[i]]++;
+    }
+    int *d = scratch.sorted.data();
+    int pos = 0;
+    for (int value = n - 1; value >= 0; value--) {
+        for (int c = scratch.count[value]; c > 0; c--) {
+            d[pos++] = value;
+        }
+    }
+
+    // Prefix sums over the sorted degrees
+    long long *prefix = scratch.prefix.data();
+    prefix[0] = 0;
+    int i = 0;
+#ifdef __AVX2__
+    // Four degrees at a time: scan inside each 128-bit lane, carry the low lane's total into
+    // the high lane, then add the running total carried over from the previous four
+    __m256i carry = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(d + i)));
+        x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+        __m256i low = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 1, 1));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+        x = _mm256_add_epi64(x, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(prefix + i + 1), x);
+        carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+#endif
+    for (; i < n; i++) {
+        prefix[i + 1] = prefix[i] + d[i];
+    }
+
+    // The sum of degrees must be even
+    if (prefix[n] % 2 != 0) return false;
+
+    // For every k: sum of the k largest degrees <= k(k-1) + sum over the rest of min(d_i, k).
+    // Degrees from index w onwards are below k; w only moves left as k grows.
+    int w = n;
+    for (int k = 1; k <= n; k++) {
+        while (w > 0 && d[w - 1] < k) w--;
+        int split = max(w, k);
+        long long rhs = (long long)k * (k - 1) + (long long)k * (split - k) + (prefix[n] - prefix[split]);
+        if (prefix[k] > rhs) return false;
+    }
+    return true;
+}
+
+// Check many degree sequences stored back to back in one flat buffer.
+// Sequence i occupies degrees[offsets[i] .. offsets[i + 1]), and graphical[i] receives its verdict.
+void checkGraphicalBatch(const vector<int> &degrees, const vector<size_t> &offsets, vector<char> &graphical) {
+    size_t count = offsets.empty() ? 0 : offsets.size() - 1;
+    graphical.assign(count, 0);
+
+    ScratchArena<GraphicalScratch> scratch;
+    parallelFor(0, count, [&](size_t i) {
+        int n = (int)(offsets[i + 1] - offsets[i]);
+        graphical[i] = erdosGallai(degrees.data() + offsets[i], n, scratch.local());
+    });
+}
+
+// Batch mode: each input line is "n d1 d2 ... dn", and one verdict is printed per line.
+// A malformed line stops the run with an error naming it, so no verdict can drift off its line.
+int runBatch() {
+    vector<int> degrees;
+    vector<size_t> offsets(1, 0);
+    string line;
+    long long lineNumber = 0;
+    while (getline(cin, line)) {
+        lineNumber++;
+        istringstream in(line);
+        int n;
+        if (!(in >> n)) {
+            if (in.eof()) continue; // Blank line
+            cerr << "Error: line " << lineNumber << ": expected the sequence length" << endl;
+            return 1;
+        }
+        if (n < 0) {
+            cerr << "Error: line " << lineNumber << ": negative sequence length " << n << endl;
+            return 1;
+        }
+        for (int i = 0; i < n; i++) {
+            int d;
+            if (!(in >> d)) {
+                cerr << "Error: line " << lineNumber << ": expected " << n << " degrees, found " << i << endl;
+                return 1;
+            }
+            degrees.push_back(d);
+        }
+        string extra;
+        if (in >> extra) {
+            cerr << "Error: line " << lineNumber << ": more than " << n << " degrees" << endl;
+            return 1;
+        }
+        offsets.push_back(degrees.size());
+    }
+
+    vector<char> graphical;
+    checkGraphicalBatch(degrees, offsets, graphical);
+
+    string out;
+    for (char g : graphical) {
+        out += g ? "graphical\n" : "not graphical\n";
+    }
+    cout << out;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && string(argv[1]) == "--batch") {
+        return runBatch();
+    }
+
     int n;
     cout << "Enter the number of vertices: ";
     cin >> n;
@@ -4,12 +4,23 @@
 #include <climits>
 #include <algorithm>
 #include <set>
+#include <limits>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <type_traits>
+#include <cmath>
+#include "parallel.h"
 
 using namespace std;
 
-// Define a structure to represent an edge for Kruskal's algorithm
+// Define a structure to represent an edge for Kruskal's algorithm, templated on the weight type
+template <typename W>
 struct Edge {
-    int src, dest, weight;
+    int src, dest;
+    W weight;
 };
 
 // Define a structure to represent a subset for union-find in Kruskal's algorithm
@@ -18,7 +29,8 @@ struct Subset {
 };
 
 // Compare function for sorting edges based on their weights in Kruskal's algorithm
-bool compareEdges(const Edge &a, const Edge &b) {
+template <typename W>
+bool compareEdges(const Edge<W> &a, const Edge<W> &b) {
     return a.weight < b.weight;
 }
 
@@ -45,8 +57,9 @@ void Union(Subset subsets[], int x, int y) {
 }
 
 // Kruskal's algorithm to find Minimum Spanning Tree
-void Kruskal(vector<Edge> &edges, int V, vector<Edge> &mst) {
-    sort(edges.begin(), edges.end(), compareEdges);
+template <typename W>
+void Kruskal(vector<Edge<W>> &edges, int V, vector<Edge<W>> &mst) {
+    parallelSort(edges.begin(), edges.end(), compareEdges<W>);
 
     Subset *subsets = new Subset[V];
     for (int i = 0; i < V; ++i) {
@@ -56,7 +69,7 @@ void Kruskal(vector<Edge> &edges, int V, vector<Edge> &mst) {
 
     int edgeIndex = 0;
     while (mst.size() < V - 1) {
-        Edge nextEdge = edges[edgeIndex++];
+        Edge<W> nextEdge = edges[edgeIndex++];
 
         int x = find(subsets, nextEdge.src);
         int y = find(subsets, nextEdge.dest);
@@ -68,21 +81,215 @@ void Kruskal(vector<Edge> &edges, int V, vector<Edge> &mst) {
     }
 
     cout << "Kruskal's MST edges:" << endl;
-    for (const Edge &edge : mst)
-        cout << edge.src << " -- " << edge.dest << " == " << edge.weight << endl;
+    for (const Edge<W> &edge : mst)
+        cout << edge.src << " -- " << edge.dest << " == " << +edge.weight << endl; // Unary + prints one-byte weights as numbers
 
     delete[] subsets;
 }
 
+// Maximum number of sorted runs merged at once, which bounds open files and buffer memory
+const size_t MAX_FAN_IN = 64;
+
+// Sort a buffered block of edges by weight and write it to a binary run file; false if the write fails.
+// The sort stays sequential and in place: parallelSort's merge buffers would exceed the one-block budget.
+template <typename W>
+bool writeRun(vector<Edge<W>> &block, const string &name) {
+    sort(block.begin(), block.end(), compareEdges<W>);
+    ofstream out(name, ios::binary);
+    out.write(reinterpret_cast<const char *>(block.data()), block.size() * sizeof(Edge<W>));
+    out.close();
+    block.clear();
+    return !out.fail();
+}
+
+// K-way merge of sorted run files, passing edges to sink in weight order until it returns false.
+// Returns false if a run cannot be opened or ends in a partial record.
+template <typename W, typename Sink>
+bool mergeRuns(const vector<string> &runs, Sink sink) {
+    vector<vector<char>> buffers(runs.size(), vector<char>(1 << 20));
+    vector<ifstream> inputs(runs.size());
+    vector<Edge<W>> heads(runs.size());
+    priority_queue<pair<W, int>, vector<pair<W, int>>, greater<pair<W, int>>> pq;
+
+    // Read the next record of run i; a clean end of file is the only accepted way to stop
+    auto advance = [&](int i) {
+        if (inputs[i].read(reinterpret_cast<char *>(&heads[i]), sizeof(Edge<W>))) {
+            pq.push({heads[i].weight, i});
+            return true;
+        }
+        return inputs[i].gcount() == 0 && inputs[i].eof() && !inputs[i].bad();
+    };
+
+    for (int i = 0; i < (int)runs.size(); ++i) {
+        inputs[i].rdbuf()->pubsetbuf(buffers[i].data(), buffers[i].size());
+        inputs[i].open(runs[i], ios::binary);
+        if (!inputs[i] || !advance(i))
+            return false;
+    }
+
+    while (!pq.empty()) {
+        int i = pq.top().second;
+        pq.pop();
+        if (!sink(heads[i]))
+            break;
+        if (!advance(i))
+            return false;
+    }
+    return true;
+}
+
+// Parse one "u v w" line; false if a field is missing, malformed, out of range or followed by extra text
+template <typename W>
+bool parseEdge(const string &line, int V, Edge<W> &edge) {
+    const char *p = line.c_str();
+    char *end;
+    errno = 0;
+    long src = strtol(p, &end, 10);
+    if (end == p) return false;
+    p = end;
+    long dest = strtol(p, &end, 10);
+    if (end == p) return false;
+    p = end;
+    if constexpr (is_integral<W>::value) {
+        long long weight = strtoll(p, &end, 10);
+        if (weight < (long long)numeric_limits<W>::min() || weight > (long long)numeric_limits<W>::max())
+            return false;
+        edge.weight = (W)weight;
+    } else {
+        // Only finite decimal weights: nan, inf and hex floats are rejected
+        double weight = strtod(p, &end);
+        if (!isfinite(weight) || find(p, (const char *)end, 'x') != end || find(p, (const char *)end, 'X') != end)
+            return false;
+        edge.weight = (W)weight;
+    }
+    if (end == p || errno == ERANGE) return false;
+    while (*end == ' ' || *end == '\t' || *end == '\r') end++;
+    if (*end != '\0' || src < 0 || src >= V || dest < 0 || dest >= V) return false;
+    edge.src = (int)src;
+    edge.dest = (int)dest;
+    return true;
+}
+
+// Semi-external Kruskal: only the union-find and one block of runEdges edges are kept in RAM.
+// Edges are read as "u v w" lines from edgeFile, sorted into runs on disk, merged and streamed
+// through the union-find, and MST edges are written to mstFile as they are found.
+// Returns false, after removing the run files, on malformed input or a failed read or write.
+template <typename W>
+bool externalKruskal(const string &edgeFile, int V, const string &mstFile, size_t runEdges) {
+    ifstream in(edgeFile);
+    if (!in) {
+        cout << "Cannot open edge file " << edgeFile << endl;
+        return false;
+    }
+
+    vector<string> runs;
+    auto fail = [&runs](const string &message) {
+        cout << message << endl;
+        for (const string &run : runs)
+            remove(run.c_str());
+        return false;
+    };
+
+    // Run formation: sort memory-sized blocks of edges and spill them to disk
+    vector<Edge<W>> block;
+    block.reserve(runEdges);
+    Edge<W> edge;
+    string line;
+    long long lineNumber = 0;
+    while (getline(in, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == string::npos)
+            continue; // Blank line
+        if (!parseEdge(line, V, edge))
+            return fail("Invalid edge on line " + to_string(lineNumber) + " of " + edgeFile + ": " + line);
+        block.push_back(edge);
+        if (block.size() == runEdges) {
+            runs.push_back(mstFile + ".run" + to_string(runs.size()));
+            if (!writeRun(block, runs.back()))
+                return fail("Cannot write run file " + runs.back());
+        }
+    }
+    if (in.bad() || !in.eof())
+        return fail("Read error in " + edgeFile + " after line " + to_string(lineNumber));
+    if (!block.empty()) {
+        runs.push_back(mstFile + ".run" + to_string(runs.size()));
+        if (!writeRun(block, runs.back()))
+            return fail("Cannot write run file " + runs.back());
+    }
+    vector<Edge<W>>().swap(block); // Release the block before merging
+
+    // Merge passes until few enough runs remain to merge in one go
+    size_t nextRun = runs.size();
+    while (runs.size() > MAX_FAN_IN) {
+        vector<string> merged;
+        for (size_t first = 0; first < runs.size(); first += MAX_FAN_IN) {
+            vector<string> group(runs.begin() + first, runs.begin() + min(first + MAX_FAN_IN, runs.size()));
+            merged.push_back(mstFile + ".run" + to_string(nextRun++));
+            ofstream out(merged.back(), ios::binary);
+            bool ok = mergeRuns<W>(group, [&out](const Edge<W> &e) {
+                out.write(reinterpret_cast<const char *>(&e), sizeof(Edge<W>));
+                return (bool)out;
+            });
+            out.close();
+            if (!ok || out.fail()) {
+                // Remove every run still on disk: the rest of this pass and the merged outputs so far
+                runs.insert(runs.end(), merged.begin(), merged.end());
+                runs.erase(runs.begin(), runs.begin() + first);
+                return fail("Cannot merge runs into " + merged.back());
+            }
+            for (const string &run : group)
+                remove(run.c_str());
+        }
+        runs.swap(merged);
+    }
+
+    // Stream the sorted edges through the union-find, writing MST edges as they are accepted
+    vector<Subset> subsets(V);
+    for (int i = 0; i < V; ++i) {
+        subsets[i].parent = i;
+        subsets[i].rank = 0;
+    }
+
+    ofstream out(mstFile);
+    if (!out)
+        return fail("Cannot open MST file " + mstFile);
+    out.precision(numeric_limits<W>::max_digits10); // Floating weights are written back exactly
+    long long mstEdges = 0;
+    bool ok = mergeRuns<W>(runs, [&](const Edge<W> &e) {
+        int x = find(subsets.data(), e.src);
+        int y = find(subsets.data(), e.dest);
+        if (x != y) {
+            out << e.src << " " << e.dest << " " << +e.weight << "\n";
+            Union(subsets.data(), x, y);
+            mstEdges++;
+        }
+        return out && mstEdges < V - 1;
+    });
+    out.close();
+    if (!ok || out.fail()) {
+        remove(mstFile.c_str()); // Never leave a partial MST behind
+        return fail("Cannot write MST file " + mstFile);
+    }
+
+    for (const string &run : runs)
+        remove(run.c_str());
+
+    cout << "External Kruskal wrote " << mstEdges << " MST edges to " << mstFile << endl;
+    if (mstEdges < V - 1)
+        cout << "The graph is not connected, so the result is a spanning forest" << endl;
+    return true;
+}
+
 // Prim's algorithm to find Minimum Spanning Tree
-void primMST(vector<vector<int>>& graph, int V, vector<Edge> &mst) {
+template <typename W>
+void primMST(vector<vector<W>>& graph, int V, vector<Edge<W>> &mst) {
     vector<int> parent(V, -1);
-    vector<int> key(V, INT_MAX);
+    vector<W> key(V, numeric_limits<W>::max());
     vector<bool> inMST(V, false);
 
     key[0] = 0;
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
-    pq.push({0, 0});
+    priority_queue<pair<W, int>, vector<pair<W, int>>, greater<pair<W, int>>> pq;
+    pq.push({W(0), 0});
 
     while (!pq.empty()) {
         int u = pq.top().second;
@@ -104,8 +311,8 @@ void primMST(vector<vector<int>>& graph, int V, vector<Edge> &mst) {
     }
 
     cout << "Prim's MST edges:" << endl;
-    for (const Edge &edge : mst) {
-        cout << edge.src << " - " << edge.dest << " Weight: " << edge.weight << endl;
+    for (const Edge<W> &edge : mst) {
+        cout << edge.src << " - " << edge.dest << " Weight: " << +edge.weight << endl;
     }
 }
 
@@ -121,15 +328,16 @@ void dfsCutset(int u, const vector<vector<int>>& mstAdj, vector<bool>& visited,
 }
 
 // Find the fundamental cutsets
-void findFundamentalCutsets(const vector<Edge>& mst, int V) {
+template <typename W>
+void findFundamentalCutsets(const vector<Edge<W>>& mst, int V) {
     vector<vector<int>> mstAdj(V);
-    for (const Edge& edge : mst) {
+    for (const Edge<W>& edge : mst) {
         mstAdj[edge.src].push_back(edge.dest);
         mstAdj[edge.dest].push_back(edge.src);
     }
 
     cout << "\nFundamental Cutsets:" << endl;
-    for (const Edge& edge : mst) {
+    for (const Edge<W>& edge : mst) {
         vector<bool> visited(V, false);
         set<int> visitedNodes;
         dfsCutset(edge.src, mstAdj, visited, visitedNodes);
@@ -144,11 +352,12 @@ void findFundamentalCutsets(const vector<Edge>& mst, int V) {
 }
 
 // Find the fundamental circuits
-void findFundamentalCircuits(const vector<Edge>& mst, const vector<Edge>& edges) {
+template <typename W>
+void findFundamentalCircuits(const vector<Edge<W>>& mst, const vector<Edge<W>>& edges) {
     cout << "\nFundamental Circuits:" << endl;
-    for (const Edge& edge : edges) {
+    for (const Edge<W>& edge : edges) {
         bool inMST = false;
-        for (const Edge& mstEdge : mst) {
+        for (const Edge<W>& mstEdge : mst) {
             if ((edge.src == mstEdge.src && edge.dest == mstEdge.dest) || (edge.src == mstEdge.dest && edge.dest == mstEdge.src)) {
                 inMST = true;
                 break;
@@ -161,7 +370,53 @@ void findFundamentalCircuits(const vector<Edge>& mst, const vector<Edge>& edges)
     }
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    // External mode: fourthquestioncode --external <edge file> <V> <MST file> [edges per run] [--weights int|int64|double]
+    if (argc >= 5 && string(argv[1]) == "--external") {
+        char *end;
+        errno = 0;
+        long long V = strtoll(argv[3], &end, 10);
+        if (*end != '\0' || errno == ERANGE || V <= 0 || V > INT_MAX) {
+            cout << "Invalid vertex count " << argv[3] << endl;
+            return 1;
+        }
+        long long runEdges = 1LL << 24;
+        string weights = "int";
+        bool runEdgesSet = false;
+        for (int i = 5; i < argc; i++) {
+            if (string(argv[i]) == "--weights") {
+                if (i + 1 == argc) {
+                    cout << "Missing weight type after --weights" << endl;
+                    return 1;
+                }
+                weights = argv[++i];
+                if (weights != "int" && weights != "int64" && weights != "double") {
+                    cout << "Invalid weight type " << weights << ", expected int, int64 or double" << endl;
+                    return 1;
+                }
+            } else if (!runEdgesSet) {
+                errno = 0;
+                runEdges = strtoll(argv[i], &end, 10);
+                if (*end != '\0' || errno == ERANGE || runEdges <= 0) {
+                    cout << "Invalid edges per run " << argv[i] << endl;
+                    return 1;
+                }
+                runEdgesSet = true;
+            } else {
+                cout << "Unexpected argument " << argv[i] << endl;
+                return 1;
+            }
+        }
+        bool ok;
+        if (weights == "int64")
+            ok = externalKruskal<long long>(argv[2], (int)V, argv[4], (size_t)runEdges);
+        else if (weights == "double")
+            ok = externalKruskal<double>(argv[2], (int)V, argv[4], (size_t)runEdges);
+        else
+            ok = externalKruskal<int>(argv[2], (int)V, argv[4], (size_t)runEdges);
+        return ok ? 0 : 1;
+    }
+
     int V;
     cout << "Enter the number of vertices: ";
     cin >> V;
@@ -176,7 +431,7 @@ int main() {
     }
 
     // Convert adjacency matrix to edge list for Kruskal's algorithm
-    vector<Edge> edges;
+    vector<Edge<int>> edges;
     for (int i = 0; i < V; ++i) {
         for (int j = i + 1; j < V; ++j) {
             if (graph[i][j] != 0) {  // If there's an edge
@@ -186,7 +441,7 @@ int main() {
     }
 
     // Create vectors to store MST edges for both algorithms
-    vector<Edge> primMSTResult, kruskalMSTResult;
+    vector<Edge<int>> primMSTResult, kruskalMSTResult;
 
     // Call Prim's algorithm
     primMST(graph, V, primMSTResult);
@@ -0,0 +1,248 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Shared parallel runtime for the graph programs: one work-stealing thread pool per process,
+// parallelFor over index ranges, parallelSort and per-thread scratch arenas.
+// By default the pool has one thread per CPU the process may run on (its affinity mask, which
+// reflects taskset and cpusets). GRAPH_THREADS sets the total number of threads instead
+// (1 runs everything on the calling thread), and GRAPH_PIN_THREADS=1 pins worker i to the
+// i-th allowed CPU (by number, not by NUMA node).
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class ThreadPool {
+public:
+    // The process-wide pool shared by every algorithm
+    static ThreadPool &instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    int workers() const { return workerCount; }        // Number of worker threads
+    int slots() const { return workers() + 1; }        // Workers plus the calling thread
+
+    // Slot of the current thread: its worker index, or workers() for any other thread
+    int currentSlot() const { return slot() < 0 ? workers() : slot(); }
+
+    // Queue a task on the current thread's deque; idle workers steal it from there
+    void submit(std::function<void()> task) {
+        Queue &q = *queues[currentSlot()];
+        {
+            std::lock_guard<std::mutex> lock(q.m);
+            q.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    // Run one queued task: newest from our own deque first, otherwise steal the oldest from another
+    bool runPending() {
+        int self = currentSlot();
+        std::function<void()> task;
+        for (int k = 0; k < slots() && !task; k++) {
+            Queue &q = *queues[(self + k) % slots()];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (q.tasks.empty())
+                continue;
+            if (k == 0) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+        }
+        if (!task)
+            return false;
+        queued--;
+        task();
+        return true;
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &t : threads)
+            t.join();
+    }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    int workerCount;                            // Fixed before any worker starts
+    std::vector<std::unique_ptr<Queue>> queues; // One per slot
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{0};
+    bool stopping = false;
+
+    static int &slot() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    // CPUs in the process affinity mask; empty where that mask is unavailable
+    static std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE && (int)cpus.size() < CPU_COUNT(&set); cpu++)
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+        }
+#endif
+        return cpus;
+    }
+
+    ThreadPool() {
+        std::vector<int> cpus = allowedCpus();
+        int total = cpus.empty() ? (int)std::thread::hardware_concurrency() : (int)cpus.size();
+        if (const char *env = std::getenv("GRAPH_THREADS"))
+            total = std::atoi(env);
+        total = std::max(total, 1);
+        const char *pinEnv = std::getenv("GRAPH_PIN_THREADS");
+        bool pin = pinEnv && std::atoi(pinEnv) != 0;
+
+        workerCount = total - 1;
+        for (int i = 0; i < total; i++)
+            queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        threads.reserve(workerCount);
+        for (int i = 0; i < workerCount; i++) {
+            threads.push_back(std::thread([this, i]() { workerLoop(i); }));
+#ifdef __linux__
+            if (pin && cpus.empty()) {
+                std::cerr << "Warning: cannot read the CPU affinity mask, worker " << i << " is not pinned" << std::endl;
+            } else if (pin) {
+                // Worker i goes to the i-th allowed CPU; this ignores the NUMA layout,
+                // which may interleave CPU numbers across nodes
+                int cpu = cpus[i % cpus.size()];
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                int error = pthread_setaffinity_np(threads.back().native_handle(), sizeof(set), &set);
+                if (error != 0)
+                    std::cerr << "Warning: cannot pin worker " << i << " to CPU " << cpu << ": " << std::strerror(error) << std::endl;
+            }
+#endif
+        }
+    }
+
+    void workerLoop(int index) {
+        slot() = index;
+        while (true) {
+            if (runPending())
+                continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]() { return stopping || queued > 0; });
+            if (stopping)
+                return;
+        }
+    }
+};
+
+// Call body(i) for every i in [begin, end) on the shared pool.
+// With grain 0 the range is cut into about eight chunks per thread.
+// The caller runs chunks too while it waits, so nested calls cannot deadlock.
+template <typename Body>
+void parallelFor(size_t begin, size_t end, Body body, size_t grain = 0) {
+    if (begin >= end)
+        return;
+    ThreadPool &pool = ThreadPool::instance();
+    size_t n = end - begin;
+    if (grain == 0)
+        grain = std::max<size_t>(1, n / (pool.slots() * 8));
+    if (pool.workers() == 0 || n <= grain) {
+        for (size_t i = begin; i < end; i++)
+            body(i);
+        return;
+    }
+
+    size_t chunks = (n + grain - 1) / grain;
+    std::atomic<size_t> remaining(chunks);
+    auto runChunk = [&](size_t c) {
+        size_t first = begin + c * grain;
+        size_t last = std::min(first + grain, end);
+        for (size_t i = first; i < last; i++)
+            body(i);
+        remaining--;
+    };
+    for (size_t c = 1; c < chunks; c++)
+        pool.submit([&runChunk, c]() { runChunk(c); });
+    runChunk(0);
+    while (remaining > 0) {
+        if (!pool.runPending())
+            std::this_thread::yield();
+    }
+}
+
+// Sort blocks in parallel, then merge neighbouring blocks pairwise in parallel rounds
+template <typename It, typename Compare>
+void parallelSort(It first, It last, Compare comp) {
+    size_t n = last - first;
+    size_t parts = ThreadPool::instance().slots();
+    if (parts == 1 || n < (size_t(1) << 14)) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t i = 0; i <= parts; i++)
+        bounds[i] = n * i / parts;
+
+    parallelFor(0, parts, [&](size_t i) {
+        std::sort(first + bounds[i], first + bounds[i + 1], comp);
+    }, 1);
+    for (size_t width = 1; width < parts; width *= 2) {
+        parallelFor(0, (parts + 2 * width - 1) / (2 * width), [&](size_t j) {
+            size_t lo = j * 2 * width;
+            size_t mid = std::min(lo + width, parts);
+            size_t hi = std::min(lo + 2 * width, parts);
+            if (mid < hi)
+                std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], comp);
+        }, 1);
+    }
+}
+
+// One T per pool slot, padded to a cache line, so each thread reuses its own scratch buffers.
+// Only the pool's workers and a single outside thread may use it at the same time.
+template <typename T>
+class ScratchArena {
+public:
+    ScratchArena() : perSlot(ThreadPool::instance().slots()) {}
+    T &local() { return perSlot[ThreadPool::instance().currentSlot()].value; }
+
+private:
+    struct alignas(64) Slot {
+        T value;
+    };
+    std::vector<Slot> perSlot;
+};
+
+#endif
@@ -1,77 +1,165 @@
 #include <iostream>
 #include <vector>
 #include <queue>
-#include <climits>
 #include <cstdlib>
 #include <ctime>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <sstream>
+#include <cerrno>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "parallel.h"
 
 using namespace std;
 
-// Graph structure using adjacency list
+// Graph structure using adjacency list, templated on the edge weight type
+// (uint8_t, uint16_t, int32_t, int64_t, float or double)
+template <typename W>
 class Graph
 {
-    int V;                       // Number of vertices
-    vector<pair<int, int>> *adj; // Adjacency list: (destination, weight)
+    int V;                  // Number of vertices
+    vector<int> *adjVertex; // Adjacency list: destinations
+    vector<W> *adjWeight;   // Weights kept apart from destinations so W alone sets their size
 
 public:
-    Graph(int V);                      // Constructor
-    void addEdge(int u, int v, int w); // Add edge with weight
-    void dijkstra(int src);            // Dijkstra's Algorithm
-    void bellmanFord(int src);         // Bellman-Ford Algorithm
+    // Distances are summed in a wider type than the weights so long paths cannot overflow
+    typedef typename conditional<is_integral<W>::value, long long, double>::type Dist;
+
+    Graph(int V);                    // Constructor
+    int vertices() const { return V; } // Number of vertices
+    void addEdge(int u, int v, W w); // Add edge with weight
+    void shortestPathTree(int src, vector<Dist> &dist, vector<int> &parent); // Dijkstra distances and predecessors
+    void dijkstra(int src);          // Dijkstra's Algorithm
+    void bellmanFord(int src, ostream &out = cout); // Bellman-Ford Algorithm
 };
 
 // Constructor
-Graph::Graph(int V)
+template <typename W>
+Graph<W>::Graph(int V)
 {
     this->V = V;
-    adj = new vector<pair<int, int>>[V];
+    adjVertex = new vector<int>[V];
+    adjWeight = new vector<W>[V];
 }
 
 // Add edge to the graph with weight
-void Graph::addEdge(int u, int v, int w)
+template <typename W>
+void Graph<W>::addEdge(int u, int v, W w)
 {
-    adj[u].push_back(make_pair(v, w));
-    adj[v].push_back(make_pair(u, w)); // For undirected graph
+    adjVertex[u].push_back(v);
+    adjWeight[u].push_back(w);
+    adjVertex[v].push_back(u); // For undirected graph
+    adjWeight[v].push_back(w);
 }
 
-// Dijkstra's algorithm for shortest paths from src
-void Graph::dijkstra(int src)
+// Dijkstra's algorithm: fills dist and parent (-1 for the source and unreachable vertices)
+template <typename W>
+void Graph<W>::shortestPathTree(int src, vector<Dist> &dist, vector<int> &parent)
 {
-    // Priority queue to store (distance, vertex)
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+    const Dist INF = numeric_limits<Dist>::max();
 
     // Initialize distances to infinity
-    vector<int> dist(V, INT_MAX);
+    dist.assign(V, INF);
+    parent.assign(V, -1);
     dist[src] = 0; // Distance to source is 0
-    pq.push(make_pair(0, src));
 
-    while (!pq.empty())
+    if constexpr (is_same<W, uint8_t>::value)
+    {
+        // Dial's algorithm: every weight is below 256, so a circular array of 256 buckets
+        // indexed by distance replaces the priority queue. Wider weights stay on the heap,
+        // since this loop visits every distance value up to the largest one.
+        const int BUCKETS = 256;
+        vector<vector<int>> buckets(BUCKETS);
+        buckets[0].push_back(src);
+        long long pending = 1;
+
+        for (Dist d = 0; pending > 0; d++)
+        {
+            vector<int> &bucket = buckets[d % BUCKETS];
+            while (!bucket.empty())
+            {
+                int u = bucket.back();
+                bucket.pop_back();
+                pending--;
+
+                // Skip entries left behind by a later improvement
+                if (dist[u] != d)
+                    continue;
+
+                for (size_t k = 0; k < adjVertex[u].size(); k++)
+                {
+                    int v = adjVertex[u][k];
+                    Dist nd = d + adjWeight[u][k];
+                    if (dist[v] > nd)
+                    {
+                        dist[v] = nd;
+                        parent[v] = u;
+                        buckets[nd % BUCKETS].push_back(v);
+                        pending++;
+                    }
+                }
+            }
+        }
+    }
+    else
     {
-        int u = pq.top().second;
-        pq.pop();
+        // Priority queue to store (distance, vertex)
+        priority_queue<pair<Dist, int>, vector<pair<Dist, int>>, greater<pair<Dist, int>>> pq;
+        pq.push(make_pair(Dist(0), src));
 
-        // Explore all neighbors of u
-        for (vector<pair<int, int>>::iterator it = adj[u].begin(); it != adj[u].end(); ++it)
+        while (!pq.empty())
         {
-            pair<int, int> neighbor = *it;
+            Dist d = pq.top().first;
+            int u = pq.top().second;
+            pq.pop();
 
-            int v = neighbor.first;
-            int weight = neighbor.second;
+            // Skip entries left behind by a later improvement
+            if (d > dist[u])
+                continue;
 
-            // Relax the edge
-            if (dist[v] > dist[u] + weight)
+            // Explore all neighbors of u
+            for (size_t k = 0; k < adjVertex[u].size(); k++)
             {
-                dist[v] = dist[u] + weight;
-                pq.push(make_pair(dist[v], v));
+                int v = adjVertex[u][k];
+                W weight = adjWeight[u][k];
+
+                // Relax the edge
+                if (dist[v] > dist[u] + weight)
+                {
+                    dist[v] = dist[u] + weight;
+                    parent[v] = u;
+                    pq.push(make_pair(dist[v], v));
+                }
             }
         }
     }
+}
+
+// Dijkstra's algorithm for shortest paths from src
+template <typename W>
+void Graph<W>::dijkstra(int src)
+{
+    const Dist INF = numeric_limits<Dist>::max();
+    vector<Dist> dist;
+    vector<int> parent;
+    shortestPathTree(src, dist, parent);
 
     // Print the shortest distances
     cout << "Dijkstra's Shortest Paths from vertex " << src << ":\n";
     for (int i = 0; i < V; i++)
     {
-        if (dist[i] == INT_MAX)
+        if (dist[i] == INF)
             cout << "Vertex " << i << ": Unreachable\n";
         else
             cout << "Vertex " << i << ": " << dist[i] << "\n";
@@ -79,67 +167,448 @@ void Graph::dijkstra(int src)
 }
 
 // Bellman-Ford algorithm for shortest paths from src
-void Graph::bellmanFord(int src)
+template <typename W>
+void Graph<W>::bellmanFord(int src, ostream &out)
 {
-    vector<int> dist(V, INT_MAX);
+    const Dist INF = numeric_limits<Dist>::max();
+    vector<Dist> dist(V, INF);
     dist[src] = 0;
 
-    // Relax all edges |V|-1 times
+    // Relax all edges |V|-1 times. Each round computes every vertex's new distance from the
+    // previous round's distances, so vertices are updated in parallel without sharing writes.
+    vector<Dist> next(V);
     for (int i = 1; i <= V - 1; i++)
     {
-        for (int u = 0; u < V; u++)
+        atomic<bool> changed(false);
+        parallelFor(0, V, [&](size_t v)
         {
-            for (vector<pair<int, int>>::iterator it = adj[u].begin(); it != adj[u].end(); ++it)
+            Dist best = dist[v];
+            for (size_t k = 0; k < adjVertex[v].size(); k++)
             {
-                pair<int, int> neighbor = *it; // Get the neighbor as a pair
-                                               // Process neighbor here
-
-                int v = neighbor.first;
-                int weight = neighbor.second;
-
-                if (dist[u] != INT_MAX && dist[v] > dist[u] + weight)
-                {
-                    dist[v] = dist[u] + weight;
-                }
+                int u = adjVertex[v][k];
+                W weight = adjWeight[v][k];
+                if (dist[u] != INF && best > dist[u] + weight)
+                    best = dist[u] + weight;
             }
-        }
+            next[v] = best;
+            if (best != dist[v])
+                changed.store(true, memory_order_relaxed);
+        });
+        dist.swap(next);
+
+        // Nothing improved, so later rounds cannot improve anything either
+        if (!changed)
+            break;
     }
 
     // Check for negative-weight cycles
     for (int u = 0; u < V; u++)
     {
-        for (vector<pair<int, int>>::iterator it = adj[u].begin(); it != adj[u].end(); ++it)
+        for (size_t k = 0; k < adjVertex[u].size(); k++)
         {
-            pair<int, int> neighbor = *it; // Get the neighbor as a pair
-                                           // Process neighbor here
-
-            int v = neighbor.first;
-            int weight = neighbor.second;
-            if (dist[u] != INT_MAX && dist[v] > dist[u] + weight)
+            int v = adjVertex[u][k];
+            W weight = adjWeight[u][k];
+            if (dist[u] != INF && dist[v] > dist[u] + weight)
             {
-                cout << "Graph contains a negative-weight cycle\n";
+                out << "Graph contains a negative-weight cycle\n";
                 return;
             }
         }
     }
 
     // Print the shortest distances
-    cout << "Bellman-Ford Shortest Paths from vertex " << src << ":\n";
+    out << "Bellman-Ford Shortest Paths from vertex " << src << ":\n";
     for (int i = 0; i < V; i++)
     {
-        if (dist[i] == INT_MAX)
-            cout << "Vertex " << i << ": Unreachable\n";
+        if (dist[i] == INF)
+            out << "Vertex " << i << ": Unreachable\n";
         else
-            cout << "Vertex " << i << ": " << dist[i] << "\n";
+            out << "Vertex " << i << ": " << dist[i] << "\n";
+    }
+}
+
+// LRU cache of Dijkstra shortest-path trees keyed by source vertex, safe to share between threads.
+// Trees are handed out as shared pointers, so an eviction never frees a tree a query is still reading.
+template <typename W>
+class ShortestPathCache
+{
+public:
+    typedef typename Graph<W>::Dist Dist;
+
+    struct Tree
+    {
+        vector<Dist> dist;  // Distance from the source to every vertex
+        vector<int> parent; // Predecessor on the shortest path, -1 if none
+    };
+    typedef shared_ptr<const Tree> TreePtr;
+
+    ShortestPathCache(Graph<W> &g, size_t capacity) : g(g), capacity(capacity) {}
+
+    // Make the trees for a batch of sources resident, computing the uncached ones in parallel.
+    // Only the last capacity distinct sources are kept, since later ones would evict earlier ones.
+    // Returns the number of sources kept.
+    size_t prefetch(const vector<int> &sources)
+    {
+        vector<int> kept; // Distinct sources, newest first
+        unordered_set<int> seen;
+        for (typename vector<int>::const_reverse_iterator it = sources.rbegin(); it != sources.rend() && kept.size() < capacity; ++it)
+            if (seen.insert(*it).second)
+                kept.push_back(*it);
+
+        // Cached sources in the batch become most recently used, so inserting the others spares them
+        vector<int> missing;
+        {
+            lock_guard<mutex> lock(m);
+            for (int src : kept)
+                if (!touch(src))
+                    missing.push_back(src);
+        }
+
+        // The lock is not held while computing, so other queries keep being answered
+        vector<TreePtr> trees(missing.size());
+        parallelFor(0, missing.size(), [&](size_t i)
+        {
+            trees[i] = compute(missing[i]);
+        }, 1);
+
+        lock_guard<mutex> lock(m);
+        for (size_t i = 0; i < missing.size(); i++)
+            insert(missing[i], trees[i]);
+
+        // Restore batch order, with the last source in the batch as the most recently used
+        for (typename vector<int>::reverse_iterator it = kept.rbegin(); it != kept.rend(); ++it)
+            touch(*it);
+        return kept.size();
+    }
+
+    // Return the tree for src, computing it only on a cache miss
+    TreePtr get(int src, bool &hit)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            hit = touch(src);
+            if (hit)
+                return entries.front().second;
+        }
+
+        TreePtr tree = compute(src);
+        lock_guard<mutex> lock(m);
+        insert(src, tree);
+        return tree;
     }
+
+private:
+    typedef typename list<pair<int, TreePtr>>::iterator Entry;
+
+    Graph<W> &g;
+    size_t capacity;
+    mutex m;                          // Guards entries and index
+    list<pair<int, TreePtr>> entries; // Most recently used first
+    unordered_map<int, Entry> index;
+
+    TreePtr compute(int src)
+    {
+        shared_ptr<Tree> tree(new Tree());
+        g.shortestPathTree(src, tree->dist, tree->parent);
+        return tree;
+    }
+
+    // Move src to the front as the most recently used; false if it is not cached. Needs the lock.
+    bool touch(int src)
+    {
+        typename unordered_map<int, Entry>::iterator found = index.find(src);
+        if (found == index.end())
+            return false;
+        entries.splice(entries.begin(), entries, found->second);
+        return true;
+    }
+
+    // Add a tree as the most recently used, evicting the least recently used beyond capacity. Needs the lock.
+    void insert(int src, const TreePtr &tree)
+    {
+        // Another query may have computed the same source meanwhile
+        if (touch(src))
+            return;
+        entries.push_front(make_pair(src, tree));
+        index[src] = entries.begin();
+        if (entries.size() > capacity)
+        {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+};
+
+// Split a line into whitespace-separated tokens
+vector<string> splitTokens(const string &line)
+{
+    istringstream in(line);
+    vector<string> tokens;
+    string token;
+    while (in >> token)
+        tokens.push_back(token);
+    return tokens;
 }
 
-int main()
+// Parse a whole token as an integer; false on any trailing characters or overflow
+bool parseInteger(const string &token, long long &value)
 {
+    char *end;
+    errno = 0;
+    value = strtoll(token.c_str(), &end, 10);
+    return !token.empty() && *end == '\0' && errno != ERANGE;
+}
+
+// Parse tokens[first..] as vertex numbers; false if any token is not a whole integer in [0, V)
+bool parseVertices(const vector<string> &tokens, size_t first, int V, vector<int> &vertices)
+{
+    vertices.clear();
+    for (size_t i = first; i < tokens.size(); i++)
+    {
+        long long v;
+        if (!parseInteger(tokens[i], v) || v < 0 || v >= V)
+            return false;
+        vertices.push_back((int)v);
+    }
+    return true;
+}
+
+// Answer one query, returning the reply text. Runs on the thread pool, so it only reads the graph.
+template <typename W>
+string answerQuery(Graph<W> &g, ShortestPathCache<W> &cache, bool negativeWeights, const string &line)
+{
+    typedef typename Graph<W>::Dist Dist;
+    const Dist INF = numeric_limits<Dist>::max();
+    ostringstream out;
+
+    vector<string> tokens = splitTokens(line);
+    const string &command = tokens[0];
+    if (command != "sssp" && command != "path" && command != "bellman" && command != "warm")
+    {
+        out << "Error: unknown command \"" << line << "\"\n";
+        return out.str();
+    }
+
+    // Every argument must be a vertex, with exactly as many as the command takes
+    vector<int> vertices;
+    size_t arguments = tokens.size() - 1;
+    bool valid = parseVertices(tokens, 1, g.vertices(), vertices) &&
+                 (command == "warm" ? arguments >= 1 : arguments == (command == "path" ? 2u : 1u));
+
+    if (!valid)
+    {
+        out << "Error: invalid arguments in \"" << line << "\"\n";
+    }
+    else if (negativeWeights && command != "bellman")
+    {
+        out << "Error: Dijkstra's algorithm needs non-negative weights, use bellman\n";
+    }
+    else if (command == "warm")
+    {
+        // Batch of sources whose trees are computed in parallel ahead of later queries
+        size_t kept = cache.prefetch(vertices);
+        out << "Warmed " << kept << " sources";
+        if (kept < unordered_set<int>(vertices.begin(), vertices.end()).size())
+            out << " (the cache keeps only the most recent " << kept << " distinct sources)";
+        out << "\n";
+    }
+    else if (command == "sssp")
+    {
+        int src = vertices[0];
+        bool hit;
+        typename ShortestPathCache<W>::TreePtr tree = cache.get(src, hit);
+        out << "Dijkstra's Shortest Paths from vertex " << src << (hit ? " (cached)" : "") << ":\n";
+        for (int i = 0; i < g.vertices(); i++)
+        {
+            if (tree->dist[i] == INF)
+                out << "Vertex " << i << ": Unreachable\n";
+            else
+                out << "Vertex " << i << ": " << tree->dist[i] << "\n";
+        }
+    }
+    else if (command == "path")
+    {
+        int src = vertices[0], dst = vertices[1];
+        bool hit;
+        typename ShortestPathCache<W>::TreePtr tree = cache.get(src, hit);
+        if (tree->dist[dst] == INF)
+        {
+            out << "Path from " << src << " to " << dst << ": Unreachable\n";
+        }
+        else
+        {
+            // Walk the predecessors back from dst, then print them in order
+            vector<int> path;
+            for (int v = dst; v != -1; v = tree->parent[v])
+                path.push_back(v);
+            out << "Path from " << src << " to " << dst << ":";
+            for (int k = (int)path.size() - 1; k >= 0; k--)
+                out << " " << path[k];
+            out << " (distance " << tree->dist[dst] << ")\n";
+        }
+    }
+    else
+    {
+        g.bellmanFord(vertices[0], out);
+    }
+    return out.str();
+}
+
+// Server mode: answer queries from stdin against a graph loaded once.
+// Queries: "sssp <src>", "path <src> <dst>", "bellman <src>", "warm <src>...", "quit".
+// Only shortest-path queries are served; MST, connectivity and Euler tours live in the other programs.
+// Queries run concurrently on the shared thread pool and each reply is written as soon as it is
+// ready, so a slow query does not hold up cached answers behind it. Replies can therefore come
+// out of order; each one starts with "Reply <n>:", where n numbers the non-blank query lines from 1.
+template <typename W>
+int serve(Graph<W> &g, size_t cacheSize, bool negativeWeights)
+{
+    ShortestPathCache<W> cache(g, cacheSize);
+    ThreadPool &pool = ThreadPool::instance();
+    mutex outputMutex;
+    atomic<long long> inFlight(0);
+    const long long maxInFlight = 4LL * pool.slots(); // Stop reading ahead while this many are pending
+
+    string line;
+    long long queryNumber = 0;
+    while (getline(cin, line))
+    {
+        vector<string> tokens = splitTokens(line);
+        if (tokens.empty())
+            continue;
+        if (tokens[0] == "quit" && tokens.size() == 1)
+            break;
+
+        long long number = ++queryNumber;
+        auto task = [&g, &cache, &outputMutex, &inFlight, negativeWeights, line, number]()
+        {
+            string reply = answerQuery(g, cache, negativeWeights, line);
+            {
+                lock_guard<mutex> lock(outputMutex);
+                cout << "Reply " << number << ":\n" << reply;
+                cout.flush();
+            }
+            inFlight--;
+        };
+
+        inFlight++;
+        if (pool.workers() == 0)
+            task();
+        else
+            pool.submit(task);
+
+        while (inFlight >= maxInFlight)
+        {
+            if (!pool.runPending())
+                this_thread::yield();
+        }
+    }
+
+    // Finish every query already read before returning
+    while (inFlight > 0)
+    {
+        if (!pool.runPending())
+            this_thread::yield();
+    }
+    return 0;
+}
+
+// Build a Graph<W> from the parsed edges and serve queries on it
+template <typename W, typename Weight>
+int buildAndServe(int V, const vector<int> &us, const vector<int> &vs, const vector<Weight> &ws,
+                  size_t cacheSize, bool negativeWeights)
+{
+    Graph<W> g(V);
+    for (size_t i = 0; i < us.size(); i++)
+        g.addEdge(us[i], vs[i], (W)ws[i]);
+    return serve(g, cacheSize, negativeWeights);
+}
+
+// Read a "V E" line and E lines of "u v w", then serve queries with the narrowest weight type that fits.
+// Integer weights are parsed as integers so large values stay exact.
+int runServer(size_t cacheSize)
+{
+    string line;
+    vector<string> tokens;
+    long long V, E;
+    if (!getline(cin, line) || (tokens = splitTokens(line)).size() != 2 ||
+        !parseInteger(tokens[0], V) || !parseInteger(tokens[1], E) ||
+        V <= 0 || V > INT_MAX || E < 0 || E > INT_MAX)
+    {
+        cout << "Error: expected a first line \"V E\" with a positive vertex count and a non-negative edge count\n";
+        return 1;
+    }
+
+    vector<int> us(E), vs(E);
+    vector<long long> intWeights(E);
+    vector<double> realWeights(E);
+    bool integral = true, negativeWeights = false;
+    long long maxWeight = 0;
+    for (int i = 0; i < E; i++)
+    {
+        long long u, v;
+        if (!getline(cin, line) || (tokens = splitTokens(line)).size() != 3 ||
+            !parseInteger(tokens[0], u) || !parseInteger(tokens[1], v))
+        {
+            cout << "Error: edge " << i << ": expected a line \"u v w\"\n";
+            return 1;
+        }
+        if (u < 0 || u >= V || v < 0 || v >= V)
+        {
+            cout << "Error: edge " << i << ": vertex out of range 0 to " << V - 1 << "\n";
+            return 1;
+        }
+        us[i] = (int)u;
+        vs[i] = (int)v;
+
+        if (parseInteger(tokens[2], intWeights[i]))
+        {
+            realWeights[i] = (double)intWeights[i];
+            maxWeight = max(maxWeight, intWeights[i]);
+        }
+        else
+        {
+            // Real weights must be finite decimal numbers; nan, inf and hex floats are rejected
+            char *end;
+            integral = false;
+            realWeights[i] = strtod(tokens[2].c_str(), &end);
+            if (*end != '\0' || !isfinite(realWeights[i]) || tokens[2].find_first_of("xX") != string::npos)
+            {
+                cout << "Error: edge " << i << ": invalid weight \"" << tokens[2] << "\"\n";
+                return 1;
+            }
+        }
+        if (realWeights[i] < 0)
+            negativeWeights = true;
+    }
+
+    if (!integral)
+        return buildAndServe<double>(V, us, vs, realWeights, cacheSize, negativeWeights);
+    if (!negativeWeights && maxWeight <= numeric_limits<uint8_t>::max())
+        return buildAndServe<uint8_t>(V, us, vs, intWeights, cacheSize, negativeWeights);
+    // uint16_t only narrows storage: its Dijkstra runs on the binary heap, not on Dial's buckets
+    if (!negativeWeights && maxWeight <= numeric_limits<uint16_t>::max())
+        return buildAndServe<uint16_t>(V, us, vs, intWeights, cacheSize, negativeWeights);
+    return buildAndServe<int64_t>(V, us, vs, intWeights, cacheSize, negativeWeights);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--serve")
+    {
+        long long cacheSize = 64;
+        if (argc > 3 || (argc == 3 && (!parseInteger(argv[2], cacheSize) || cacheSize < 1 || cacheSize > 1000000)))
+        {
+            cout << "Usage: " << argv[0] << " --serve [cache size from 1 to 1000000]\n";
+            return 1;
+        }
+        return runServer((size_t)cacheSize);
+    }
+
     srand(time(0));
 
     int V = 5; // Number of vertices
-    Graph g(V);
+    Graph<uint8_t> g(V); // Weights fit in one byte, which also selects Dial's buckets
 
     // Adding random edges with random weights
     for (int i = 0; i < V; i++)
@@ -147,7 +616,7 @@ int main()
         for (int j = i + 1; j < V; j++)
         {
             int weight = rand() % 20 + 1; // Random weight between 1 and 20
-            g.addEdge(i, j, weight);
+            g.addEdge(i, j, (uint8_t)weight);
             cout << "Weight from " << i << " to " << j << " is " << weight << endl;
         }
     }